@@ -1,6 +1,14 @@
 #ifndef BUF_H
 #define BUF_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "db.h"
 // define if debug output wanted
 //#define DEBUGBUF
@@ -8,24 +16,64 @@
 // declarations for buffer pool hash table
 struct hashBucket
 {
-	File*	file;    // pointer a file object (more on this below)
+	File*	file;    // pointer a file object, NULL if the slot is empty
 	int	pageNo;  // page number within a file
 	int	frameNo; // frame number of page in the buffer pool
-	hashBucket* 	next;	 // next node in the hash table
 };
 
 
 // hash table to keep track of pages in the buffer pool
+//
+// Open addressing with linear probing.  The table is split into
+// partitions of a power-of-two number of buckets, each guarded by its own
+// latch, so threads working on pages that hash to different partitions
+// never contend.  Every partition has its own array of buckets, allocated
+// in the constructor and only replaced by grow; insert and remove never
+// touch the heap.  A probe sequence wraps around inside its partition,
+// and remove shifts the following entries back instead of leaving
+// tombstones, so a lookup never scans further than the longest
+// displacement recorded for its partition.
+//
+// insert, lookup and remove do no locking themselves: the caller must
+// hold latch(file, pageNo) around them.  grow takes the partition latches
+// itself, one at a time.
+
+const int HTLATCHES = 64;   // maximum number of latch partitions
+const int HTMINPART = 64;   // minimum number of buckets per partition
+
+struct alignas(64) hashPartition
+{
+	std::mutex	latch;    // guards everything below
+	hashBucket*	buckets;  // this partition's buckets
+	int		size;     // how many, a power of two
+	int		count;    // number of entries in use
+	int		maxProbe; // longest displacement of any entry inserted
+	long		lookups;  // number of lookups done
+	long		probes;   // buckets examined by those lookups
+};
+
 class BufHashTbl
 {
 private:
-    int HTSIZE;
-    hashBucket**  ht; // actual hash table
-    int	 hash(const File* file, const int pageNo); // returns value between 0 and HTSIZE-1
+    int HTSIZE;           // total number of buckets
+    int partSize;         // buckets per partition, a power of two
+    int numLatches;       // number of partitions, a power of two
+    hashPartition*  parts;
+    unsigned long hash(const File* file, const int pageNo);
+    static hashBucket* newBuckets(const int n);  // n empty buckets
+
+    // partition and home bucket of (file,pageNo)
+    hashPartition& partition(const unsigned long h)
+    {
+	return parts[(h >> 32) & (numLatches - 1)];
+    }
 
 public:
-    BufHashTbl(const int htSize);  // constructor
+    BufHashTbl(const int htSize);  // constructor, htSize >= #entries
     ~BufHashTbl(); // destructor
+
+    // latch of the partition that (file,pageNo) hashes to
+  std::mutex& latch(const File* file, const int pageNo);
 	
     // insert entry into hash table mapping (file,pageNo) to frameNo;
     // returns 0 if OK, HASHTBLERROR if an error occurred
@@ -39,22 +87,59 @@ public:
     // delete entry (file,pageNo) from hash table. REturn OK if page was
     // found.  Else return HASHTBLERROR
   Status remove(const File* file, const int pageNo);  
+
+    // make room for htSize entries, rehashing one partition at a time
+    // so that each is only latched while its own entries move
+  void grow(const int htSize);
+
+    // bytes taken by the buckets and partitions
+  size_t bytes() const;
+
+    // probe statistics summed over all partitions: number of lookups,
+    // buckets examined by them and the longest displacement of any entry
+  void getProbeStats(long & lookups, long & probes, int & maxProbe);
 };
 
 
 class BufMgr;  //forward declaration of BufMgr class 
 
 // class for maintaining information about buffer pool frames
+//
+// Concurrency: file, pageNo and valid only change while the frame latch
+// is held, and a frame is only reachable through the hash table once it
+// is valid.  pinCnt and dirty are atomic so that a hit can pin a
+// page holding nothing but the hash partition latch.  The frame latch is
+// always taken before a hash partition latch, never the other way round.
+//
+// A page being read is in the hash table, with loading set, from before
+// the read starts until it is done, and its frame stays latched all that
+// time.  Another thread missing on it pins it and waits for loading to
+// clear instead of reading a copy of its own, and no evictor can touch
+// it; so a read can never bring back a copy older than one that has been
+// changed and written since.
 class BufDesc {
     friend class BufMgr;
 private:
   File* file;   // pointer to file object
   int   pageNo; // page within file
   int	frameNo;  // frame # of frame
-  int   pinCnt; // number of times this page has been pinned
-  bool 	dirty;	  // true if dirty;  false otherwise
+  std::atomic<int>  pinCnt; // number of times this page has been pinned
+  std::atomic<bool> dirty;  // true if dirty;  false otherwise
   bool 	valid;   // true if page is valid
-  bool  refbit;	 // has this buffer frame been reference recently
+  std::atomic<bool> loading; // a read into the frame is in flight
+  std::atomic<bool> latched; // frame latch, held while loading or evicting
+  int   fileNext; // next frame holding a page of the same file
+  int   filePrev; // previous one; both guarded by file->frameLatch
+
+  bool tryLatch() {
+      return !latched.exchange(true, std::memory_order_acquire);
+  }
+
+  void latch();  // spin until the frame latch is ours
+
+  void unlatch() {
+      latched.store(false, std::memory_order_release);
+  }
 
   void Clear() {  // initialize buffer frame for a new user
     	pinCnt = 0;
@@ -62,6 +147,7 @@ private:
 	pageNo = -1;
     	dirty = false;
 	valid = false;
+	loading = false;
   };
 
   void Set(File* filePtr, int pageNum) { 
@@ -70,24 +156,68 @@ private:
       pinCnt = 1;
       dirty = false;
       valid = true;
-      refbit = true;
   }
 
   BufDesc() {
+      latched = false;
+      fileNext = filePrev = -1;
       Clear();
   }
 };
 
 
+// A histogram with power-of-two buckets: bucket i counts the values in
+// [2^i, 2^(i+1)), bucket 0 counts 0 and 1 as well.  Adding a value is
+// two atomic increments, so it may be updated from any thread and read
+// while it is.
+
+const int HISTBUCKETS = 40;
+
+struct Histogram
+{
+  std::atomic<long> count[HISTBUCKETS];
+  std::atomic<long> total;      // sum of all the values added
+
+  void add(const long value);
+  long samples() const;
+  long percentile(const double p) const; // upper bound of the bucket
+                                         // holding the p-th percentile
+  void print(ostream & os) const;        // as a JSON object
+  void clear();
+
+  Histogram()
+    {
+      clear();
+    }
+};
+
+
 struct BufStats
 {
-  int accesses;    // Total number of accesses to buffer pool
-  int diskreads;   // Number of pages read from disk (including allocs)
-  int diskwrites;  // Number of pages written back to disk
+  Counter accesses;              // Total number of accesses to buffer pool
+  std::atomic<long> diskreads;   // Number of pages read from disk (including allocs)
+  std::atomic<long> diskwrites;  // Number of pages written back to disk
+  std::atomic<long> prefetches;  // Number of those reads done ahead of time
+  std::atomic<long> flushwrites; // Writes by the background flusher
+  Counter hits;                  // readPage calls finding the page resident
+  std::atomic<long> misses;      // readPage calls that had to read it
+  std::atomic<long> cleanevicts; // victims that were clean
+  std::atomic<long> dirtyevicts; // victims written back by the evicting thread
+
+  Histogram sweeps;      // frames allocBuf looked at to find a victim
+  Histogram pinwait;     // ns a miss waited before its page was pinned
+  Histogram readtime;    // ns per read call, which may cover many pages
+  Histogram writetime;   // ns per write call, likewise
 
   void clear()
     {
-      accesses = diskreads = diskwrites = 0;
+      accesses = diskreads = diskwrites = prefetches = 0;
+      flushwrites = 0;
+      hits = misses = cleanevicts = dirtyevicts = 0;
+      sweeps.clear();
+      pinwait.clear();
+      readtime.clear();
+      writetime.clear();
     }
       
   BufStats()
@@ -97,37 +227,534 @@ struct BufStats
 };
 
 
+// Replacement policies.  The policy decides which frames allocBuf
+// should try to replace, in order of preference; BufMgr itself skips
+// candidates that are pinned or latched, and tells the policy about every
+// page that is referenced, loaded, evicted or dropped.  The policy is
+// chosen when the BufMgr is constructed, with room for the most frames
+// the pool may ever be resized to.
+
+enum ReplPolicy {
+  CLOCK,   // classic clock with one reference bit per frame
+  TWOQ     // scan-resistant 2Q (Johnson & Shasha)
+};
+
+class BufPolicy
+{
+public:
+  BufPolicy(const int bufs, const int maxBufs);
+  virtual ~BufPolicy() {}
+
+  virtual const char* name() const = 0;
+
+  // a resident page in frame was pinned again
+  virtual void touched(const int frame) = 0;
+
+  // (file,pageNo) was read into frame, which allocBuf had handed out
+  virtual void loaded(const int frame, const File* file, const int pageNo) = 0;
+
+  // the page (file,pageNo) in frame was chosen as a victim and replaced
+  virtual void evicted(const int frame, const File* file, const int pageNo) = 0;
+
+  // frame was emptied without being replaced (dispose, flush, unused)
+  virtual void freed(const int frame) = 0;
+
+  // Next frame to try to replace, or -1 to spend one step without a
+  // candidate.  cursor is -1 on the first call of a sweep and is carried
+  // by the caller between calls so that skipped frames are not offered
+  // again straight away.
+  virtual int candidate(int & cursor) = 0;
+
+  // Like candidate, but without changing the policy's state: the frames
+  // that are likely to be asked for next, for the background flusher.
+  virtual int upcoming(int & cursor) = 0;
+
+  // How much the policy wants to keep the page in frame: frames with a
+  // higher value are given up later, whatever their place in upcoming.
+  virtual int heat(const int frame) = 0;
+
+  // Only offer frames below bufs from now on.  Frames taken away may
+  // still hold pages until BufMgr gets round to them, and are reported
+  // as evicted or freed then; if the pool grows back over them first,
+  // they are offered again from where they were.  Other frames added
+  // are empty.
+  virtual void resize(const int bufs) = 0;
+
+  // print the policy's counters; hits and misses are in BufStats
+  virtual void printStats(ostream & os) const;
+
+  std::atomic<long> evictions;  // pages replaced
+
+protected:
+  std::atomic<int> numBufs;   // frames in use
+  int maxBufs;                // frames there is room for
+};
+
+
+// Clock: frames are considered in a circle, a referenced frame gets its
+// reference bit cleared and a second chance.  Needs no lock at all.
+class ClockPolicy : public BufPolicy
+{
+private:
+  std::atomic<unsigned int> clockHand;
+  std::atomic<bool>*        refbit;  // has this frame been referenced recently
+
+public:
+  ClockPolicy(const int bufs, const int maxBufs);
+  ~ClockPolicy();
+
+  const char* name() const { return "clock"; }
+  void touched(const int frame);
+  void loaded(const int frame, const File* file, const int pageNo);
+  void evicted(const int frame, const File* file, const int pageNo);
+  void freed(const int frame);
+  int  candidate(int & cursor);
+  int  upcoming(int & cursor);
+  int  heat(const int frame);
+  void resize(const int bufs);
+};
+
+
+// 2Q: a page seen for the first time goes on the FIFO queue A1in and is
+// evicted from there unless it is referenced again after it has left
+// A1in; the keys of pages evicted from A1in are remembered in the ghost
+// queue A1out, and a page loaded while its key is in A1out goes on the
+// LRU list Am.  A single scan therefore only ever displaces A1in, which
+// is kept to a quarter of the pool.  The lists live in arrays indexed by
+// frame and are guarded by one latch; a hit that finds the latch busy
+// skips its move to the front of Am rather than waiting.
+class TwoQPolicy : public BufPolicy
+{
+private:
+  enum { NONE = -1, FREE = 0, A1IN = 1, AM = 2, NUMLISTS = 3 };
+
+  std::mutex  latch;
+  int*        next;      // next frame towards the tail of its list
+  int*        prev;      // previous frame towards the head of its list
+  int*        where;     // list the frame is on
+  int         head[NUMLISTS];
+  int         tail[NUMLISTS];
+  int         size[NUMLISTS];
+  int         kin;       // target size of A1in
+  int         kout;      // number of keys remembered in A1out
+  hashBucket* ghosts;    // ring of keys evicted from A1in
+  int         ghostNext; // oldest entry of the ring
+  BufHashTbl* ghostTbl;  // key -> position in ghosts
+
+  void unlink(const int frame);
+  void pushHead(const int list, const int frame);
+
+public:
+  TwoQPolicy(const int bufs, const int maxBufs);
+  ~TwoQPolicy();
+
+  const char* name() const { return "2q"; }
+  void touched(const int frame);
+  void loaded(const int frame, const File* file, const int pageNo);
+  void evicted(const int frame, const File* file, const int pageNo);
+  void freed(const int frame);
+  int  candidate(int & cursor);
+  int  upcoming(int & cursor);
+  int  heat(const int frame);
+  void resize(const int bufs);
+  void printStats(ostream & os) const;
+
+  std::atomic<long> ghostHits;   // loads of pages remembered in A1out
+};
+
+
+// Second-tier cache: pages evicted from the pool are kept compressed in
+// memory, up to a number of bytes, and readPage looks there before going
+// to disk.  Only pages whose contents are on disk are ever put in, so an
+// entry is always the same as the disk copy; BufMgr takes an entry out
+// when the page comes back into the pool, only ever in the thread whose
+// claim on the page makes the others wait, and drops entries for pages
+// it disposes of or flushes.  Least recently put entries go first.
+
+struct cacheEntry
+{
+  File*	file;     // NULL if the entry is free
+  int	pageNo;
+  char*	data;     // compressed page
+  int	length;   // bytes at data
+  int	prev;     // put order, newest at the head
+  int	next;     // or the free list
+  int	filePrev; // other entries of the same file
+  int	fileNext;
+};
+
+class PageCache
+{
+public:
+  PageCache(const size_t capacity);
+  ~PageCache();
+
+  // keep a copy of the size bytes at page; a no-op if the page does
+  // not compress
+  void put(File* file, const int pageNo, const Page* page, const int size);
+
+  // move (file,pageNo) out of the cache into page; false if not there
+  bool take(const File* file, const int pageNo, Page* page, const int size);
+
+  // forget one page, or all pages of a file
+  void erase(const File* file, const int pageNo);
+  void eraseFile(const File* file);
+
+  void printStats(ostream & os) const;   // as a JSON object
+
+  // bytes held, data, entries and index together, and number of entries
+  void getUsage(size_t & bytes, int & numEntries) const;
+
+  std::atomic<long> hits;       // take calls finding the page
+  std::atomic<long> misses;     // take calls not finding it
+  std::atomic<long> puts;       // pages stored
+  std::atomic<long> rejects;    // pages that did not compress or fit
+  std::atomic<long> evictions;  // entries dropped to make room
+  std::atomic<long> rawBytes;   // bytes of the pages stored, uncompressed
+  std::atomic<long> zipBytes;   // bytes they took compressed
+
+private:
+  mutable std::mutex latch;     // guards everything below
+  size_t	capacity;       // bytes allowed, entries and index included
+  size_t	used;           // bytes of compressed data held
+  int		numEntries;
+  cacheEntry*	entries;
+  int		freeHead;       // free entries, linked through next
+  int		head, tail;     // entries in use, newest first
+  BufHashTbl*	index;          // (file,pageNo) -> entry
+  std::map<const File*, int> fileHeads; // first entry of each file
+
+  size_t overhead() const;      // bytes taken by entries and index
+  bool grow(const size_t length); // more entries, if length still fits
+  void unlink(const int e);     // take entry e off the put order
+  void release(const int e);    // free entry e and its data
+};
+
+const int CACHEENTRIES = 64;    // entries a new cache starts with
+
+
+// a run of pages of one file to be read into the pool ahead of time
+struct PrefetchReq
+{
+  File*	file;
+  int	firstPage;
+  int	count;
+};
+
+const int SEQTRIGGER = 2;     // sequential reads of a file before read-ahead
+const int PREFETCHQUEUE = 4;  // queued requests per I/O thread, more are dropped
+
+const int ALLOCRETRIES = 4;   // times allocPages starts over before giving up
+
+const int FLUSHBATCH = 16;    // frames the flusher latches and writes at once
+const int FLUSHINTERVAL = 20; // ms between flusher checks of the dirty count
+
+const int WARMBATCH = 32;     // most pages warmStart reads between deadline checks
+
+// How the buffer pool is backed.  The pool is always an anonymous
+// mapping, so each frame is aligned to the size of a page.  POOLHUGE asks
+// for explicit huge pages for the frames in use, taking more as the pool
+// grows and giving them back as it shrinks, and falls back to
+// transparent huge pages if there are not enough for the initial pool;
+// POOLDIRECT makes files opened while the BufMgr exists use O_DIRECT, so
+// their pages are cached in the pool only and not in the kernel as well.
+
+const int POOLDIRECT = 1;
+const int POOLHUGE = 2;
+const size_t HUGEPAGESIZE = 2 << 20;
+
+// Address space for this many times the initial number of frames is
+// reserved up front, so that resize can grow the pool without moving the
+// frames that are pinned.  Memory is only used for the frames in use.
+const int POOLGROWTH = 8;
+
+
+// The buffer manager may be shared by any number of threads.  A hit
+// only takes the latch of one hash partition; a miss additionally latches
+// the victim frame chosen by the replacement policy, and several threads
+// may look for victims at the same time.
+//
+// Prefetching: prefetch() reads a run of pages into unpinned frames so
+// that later readPage calls hit.  Once enableReadAhead has been called,
+// readPage also notices files being read sequentially and keeps a window
+// of pages ahead of the reader.  With I/O threads the reads are queued
+// and done in the background; without them prefetch() reads in the
+// caller's thread.
+//
+// Background flushing: once enableFlusher has been called, a flusher
+// thread keeps the number of dirty frames between two watermarks by
+// writing back unpinned dirty frames in the order the replacement policy
+// is going to offer them, so that evictions rarely have to wait for a
+// write.
+//
+// Resizing: resize() changes the number of frames while the pool is in
+// use.  Frames never move: growing makes more of the reserved frames
+// available and grows the hash table a partition at a time, shrinking
+// stops handing out the frames above the new size and evicts their pages.
+// Pages that are pinned stay where they are until they are unpinned and
+// are evicted then; the memory of those frames goes back to the system
+// once the last of them is empty.
+
 class BufMgr 
 {
 private:
-  unsigned int 	 clockHand;
-  int   	 numBufs;    	// Number of pages in buffer pool
+  std::atomic<int> numBufs;    	// Number of pages in buffer pool
+  int		 maxBufs;	// frames reserved, the most resize allows
+  int		 builtBufs;	// frames whose descriptors are constructed
+  std::mutex	 resizeLatch;	// one resize at a time, guards shrinkTo
+  int		 shrinkTo;	// frames below may hold pages: numBufs, or
+				// more while a shrink waits for pinned ones
   BufHashTbl*    hashTable;  	// hash table mapping (File, page) to frame
   BufDesc*	 bufTable;  	// vector of status info, 1 per page
+  size_t	 tableBytes;	// length of the mapping holding bufTable
   BufStats	 bufStats;	// buffer pool statistics
+  BufPolicy*	 policy;	// chooses the frames to replace
+  PageCache*	 cache;		// compressed second tier, or NULL
+  int		 poolFlags;	// POOLDIRECT, POOLHUGE
+  int		 frameSize;	// bytes per frame, the largest page size served
+  size_t	 poolBytes;	// length of the mapping holding bufPool
+  size_t	 poolAlign;	// page size of that mapping
+  size_t	 poolCommitted;	// bytes of it backed by explicit huge pages,
+				// 0 if the pool does not use them
+
+  // back the pool with explicit huge pages up to bytes; false if there
+  // are not enough of them
+  bool commitHuge(const size_t bytes);
+
+  Page* framePage(const int frame) const // the page held by a frame
+  {
+    return (Page*)((char*)bufPool + (size_t)frame * frameSize);
+  }
 
-  const Status allocBuf(int & frame);   // allocate a free frame.  
+  int frameOf(const Page* page) const // the frame holding a page
+  {
+    return ((char*)page - (char*)bufPool) / frameSize;
+  }
+
+  // allocate a free frame; unless wait is set, frames latched by other
+  // threads count as unavailable, so a caller already holding frames
+  // cannot wait for one that holds frames it wants
+  const Status allocBuf(int & frame, const bool wait = true);
   const void releaseBuf(int frame); // return unused frame to end of list
-  void advanceClock()
+
+  // latch count free frames, or none at all
+  const Status allocFrames(const int count, std::vector<int> & frames);
+
+  // pin (file,pageNo) if it is resident, waiting for a read of it in
+  // flight; returns false on a miss
+  bool pinResident(const File* file, const int pageNo, int & frame);
+
+  // wait for the read into a frame we have pinned; false, with the pin
+  // dropped, if the read failed
+  bool waitLoaded(const int frame);
+
+  // Put (file,pageNo) in the hash table for the latched frame, pinned
+  // once unless pin is false, with a read in flight that finishLoad or
+  // abortLoad ends.  If the page is there already, frame is left alone
+  // and other is set to where the page is, pinned if pin is set.
+  const Status claimPage(File* file, const int pageNo, const int frame,
+                         int & other, const bool pin);
+  void finishLoad(const int frame);
+  void abortLoad(const int frame, const bool pinned);
+
+  // fill a claimed frame from the second tier or else from disk
+  const Status fetchPage(File* file, const int pageNo, const int frame);
+
+  // fill a claimed frame from the second tier; false if it is not there
+  bool takeCached(File* file, const int pageNo, const int frame);
+
+  // make the latched frame holding (file,pageNo) visible, pinned once
+  // unless pin is false
+  const Status installPage(File* file, const int pageNo, int frame,
+                           Page*& page, const bool pin = true);
+
+  int		 readAheadWindow;  // pages kept ahead of a sequential reader
+  int		 numIOThreads;
+  std::thread*	 ioThreads;        // background prefetch readers
+  const File**	 ioInFlight;       // file each I/O thread is reading
+  bool		 ioStopping;
+  std::mutex	 prefetchLatch;    // guards the queue and the two above
+  std::condition_variable prefetchCond;
+  std::deque<PrefetchReq> prefetchQueue;
+
+  void ioThreadMain(const int id);
+
+  // read the pages of the run that are not resident yet
+  const Status readAhead(File* file, const int firstPage, const int count);
+
+  // prefetch without checking the arguments; queued is false if the
+  // request was dropped because the queue was full
+  const Status requestPrefetch(File* file, const int firstPage,
+                               const int count, bool & queued);
+
+  // whether (file,pageNo) is in the pool at this moment
+  bool isResident(const File* file, const int pageNo);
+
+  // sort frames by (file, pageNo)
+  void sortFrames(int frames[], const int n);
+
+  // write back the dirty ones among latched, sorted frames, merging runs
+  // of consecutive pages into vectored writes
+  const Status writeFrames(const int frames[], const int n, int & written);
+
+  // readPage just returned (file,pageNo); start read-ahead if sequential
+  void noteRead(File* file, const int pageNo);
+
+  // drop queued prefetches of file and wait for those being read
+  void cancelPrefetch(const File* file);
+
+  std::atomic<int> dirtyCount;     // frames with dirty set
+  std::atomic<int> lowDirty;       // flusher stops at this many dirty frames
+  std::atomic<int> highDirty;      // and starts at this many
+  int		 lowWater;         // the same in percent of the pool,
+  int		 highWater;        // 0 until enableFlusher
+
+  void setWatermarks();            // derive lowDirty, highDirty from them
+  std::thread	 flusherThread;
+  bool		 flusherStopping;
+  std::mutex	 flushLatch;       // guards flusherStopping
+  std::condition_variable flushCond;
+
+  void flusherMain();
+
+  // write back up to FLUSHBATCH dirty frames from the policy's next
+  // candidates; returns the number written
+  int flushBatch(int & cursor, int & looked);
+
+  // set or clear a frame's dirty flag, keeping dirtyCount; markClean
+  // returns whether the frame was dirty
+  void markDirty(BufDesc* buf)
+  {
+    if (buf->dirty.exchange(true))
+      return;
+    buf->file->dirtyFrames++;
+    if (++dirtyCount == highDirty)
+      flushCond.notify_one();
+  }
+  bool markClean(BufDesc* buf)
   {
-	clockHand = (clockHand + 1) % numBufs;
+    if (!buf->dirty.exchange(false))
+      return false;
+    buf->file->dirtyFrames--;
+    dirtyCount--;
+    return true;
   }
 
+  // add the latched frame to / remove it from its file's resident list
+  void linkFrame(const int frame);
+  void unlinkFrame(const int frame);
+
+  // flushFile and dropFile: write back (or discard) and evict every
+  // frame of the file
+  const Status evictFile(const File* file, const bool write);
+
+  // evict the pages of frames [from, to), which allocBuf no longer hands
+  // out; pinned ones are left for retireFrame
+  const Status drainFrames(const int from, const int to);
+
+  // evict the page of a frame above the pool that has just been
+  // unpinned, and finish the shrink if it was the last one
+  void retireFrame(const int frame);
+
+  // give back the memory of the frames above the pool once none of them
+  // holds a page; resizeLatch must be held
+  void releaseFrames();
+
+  string	 residentList;     // saved to by the destructor, if set
+
+  // the valid frames, hottest first: by the replacement policy's heat,
+  // and among equally hot frames the reverse of the order in which it
+  // would give them up
+  void hottestFrames(std::vector<int> & frames);
+
 
 public:
   Page*	         bufPool;   // actual buffer pool
 
-  BufMgr(const int bufs);
+  BufMgr(const int bufs, const ReplPolicy replPolicy = CLOCK,
+         const int poolFlags = 0, const int frameSize = PAGESIZE);
   ~BufMgr();
 
   const Status readPage(File* file, const int PageNo, Page*& page);
   const Status unPinPage(File* file, const int PageNo, const bool dirty);
   const Status allocPage(File* file, int& PageNo, Page*& page); 
                         // allocates a new, empty page 
+  const Status allocPages(File* file, const int count, int pageNos[],
+                          Page* pages[]);
+                        // allocates count new, empty pages, all pinned
   const Status flushFile(const File* file); // writing out all dirty pages of the file
+  const Status dropFile(const File* file);  // discard all pages of the file,
+                                            // dirty or not
   const Status disposePage(File* file, const int PageNo); // dispose of page in file
+
+  // read count pages of file starting at firstPage into the pool without
+  // pinning them; a hint, so a full pool or the end of file just stops it
+  const Status prefetch(File* file, const int firstPage, const int count);
+
+  // keep window pages ahead of sequential readers, reading them with
+  // threads background threads (0: read in the caller's thread); the
+  // window may be changed later, but not the number of threads once
+  // they have been started
+  const Status enableReadAhead(const int window, const int threads);
+
+  // start the background flusher, or change its watermarks: it writes
+  // back dirty frames while more than highWater percent of the pool is
+  // dirty, until no more than lowWater percent is
+  const Status enableFlusher(const int lowWater, const int highWater);
+
+  // keep pages evicted from the pool compressed in up to bytes of
+  // memory; call before the BufMgr is shared between threads
+  const Status enableCache(const size_t bytes);
+
+  // change the pool to bufs frames, up to POOLGROWTH times the number it
+  // was created with; UNIXERR if explicit huge pages run out
+  const Status resize(const int bufs);
+
+  int getNumBufs() const // frames in the pool right now
+  {
+	return numBufs;
+  }
+
+  // Warm start.  saveResident writes the (file name, pageNo) pairs in
+  // the pool, hottest first, to listName; saveResidentOnExit makes the
+  // destructor do it.  warmStart reads back the first maxPages entries
+  // that belong to one of files, in page order with batched reads, and
+  // gives up after maxMillis milliseconds (0 for no limit).
+  const Status saveResident(const string & listName);
+  void saveResidentOnExit(const string & listName)
+  {
+	residentList = listName;
+  }
+  const Status warmStart(const string & listName, File* const files[],
+                         const int numFiles, const int maxPages,
+                         const int maxMillis, int & loaded);
+
+  const PageCache* getCache() const // the second tier, NULL if none
+  {
+	return cache;
+  }
+
   void  printSelf();
 
+  // all the statistics of the pool, its policy and of every file with
+  // pages in the pool, as one JSON object
+  void  printStats(ostream & os);
+
+  int getFrameSize() const // files with larger pages cannot be cached
+  {
+	return frameSize;
+  }
+
+  int getFrameAlign() const // every frame starts at a multiple of this
+  {
+	return frameSize < (int)poolAlign ? frameSize : (int)poolAlign;
+  }
+
+  bool directIO() const // should files bypass the kernel page cache
+  {
+	return (poolFlags & POOLDIRECT) != 0;
+  }
+
   const BufStats & getBufStats() const // get buffer pool usage
   {
 	return bufStats;
@@ -136,6 +763,11 @@ public:
   {
 	bufStats.clear();
   }
+
+  const BufPolicy & getPolicy() const // replacement policy and its stats
+  {
+	return *policy;
+  }
 };
 
 #endif
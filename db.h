@@ -2,7 +2,10 @@
 #define DB_H
 
 #include <sys/types.h>
+#include <atomic>
 #include <functional>
+#include <mutex>
+#include <vector>
 #include "error.h"
 #include <string.h>
 using namespace std;
@@ -12,23 +15,118 @@ using namespace std;
 //#define DEBUGIO
 //#define DEBUGFREE
 
+// pages per preadv/pwritev call
+const int IOVBATCH = 64;
+
+// pages a file grows by when it runs out of room
+const int EXTENTPAGES = 64;
+
 // forward class definition for db
 class DB;
 
+// A counter bumped on every buffer pool hit.  One atomic shared by all
+// threads would bounce its cache line between them on each hit, so every
+// thread adds to one of COUNTERSHARDS slots, each on a line of its own,
+// and reading the counter sums them.
+
+const int COUNTERSHARDS = 16;
+
+struct Counter
+{
+  struct alignas(64) slot
+  {
+    std::atomic<long> n;
+  };
+  slot slots[COUNTERSHARDS];
+
+  // the slot of the calling thread, handed out round robin
+  static int shard()
+    {
+      static std::atomic<int> nextShard(0);
+      thread_local int myShard = nextShard++ % COUNTERSHARDS;
+      return myShard;
+    }
+
+  void operator++(int)
+    {
+      slots[shard()].n.fetch_add(1, std::memory_order_relaxed);
+    }
+
+  operator long() const
+    {
+      long total = 0;
+      for (int i = 0; i < COUNTERSHARDS; i++)
+        total += slots[i].n.load(std::memory_order_relaxed);
+      return total;
+    }
+
+  Counter & operator=(const long value)
+    {
+      slots[0].n = value;
+      for (int i = 1; i < COUNTERSHARDS; i++)
+        slots[i].n = 0;
+      return *this;
+    }
+
+  Counter & operator=(const Counter & other)
+    {
+      return *this = (long)other;
+    }
+
+  Counter()
+    {
+      *this = 0;
+    }
+};
+
+// What the buffer manager saw of one file.  Counted with atomics, so
+// they may be read while the pool is in use.
+struct FileStats
+{
+  Counter hits;                  // readPage calls finding the page resident
+  std::atomic<long> misses;      // readPage calls that had to read it
+  std::atomic<long> diskreads;   // pages read from the file
+  std::atomic<long> diskwrites;  // pages written to the file
+  std::atomic<long> cleanevicts; // its pages evicted clean
+  std::atomic<long> dirtyevicts; // its pages written back to be evicted
+
+  void clear()
+    {
+      hits = misses = diskreads = diskwrites = 0;
+      cleanevicts = dirtyevicts = 0;
+    }
+
+  FileStats()
+    {
+      clear();
+    }
+};
+
 // class definition for open files
 class File {
   friend class DB;
   friend class OpenFileHashTbl;
+  friend class BufMgr;
 
  public:
 
   Status allocatePage(int& pageNo);     // allocate a new page
+  const Status allocatePages(const int count,
+		  int pageNos[]);             // allocate count new pages
   const Status disposePage(const int pageNo);       // release space for a page
   const Status readPage(const int pageNo,
 		  Page* pagePtr) const;       // read page from file
   const Status writePage(const int pageNo,
 		   const Page* pagePtr);      // write page to file
+  const Status readPages(const int firstPage, const int count,
+		  Page* const pages[]) const; // read consecutive pages
+  const Status writePages(const int firstPage, const int count,
+		   const Page* const pages[]); // write consecutive pages
   const Status getFirstPage(int& pageNo) const;     // returns pageNo of first page
+  int getPageSize() const { return pageSize; }      // bytes per page
+  const FileStats & getStats() const { return stats; } // buffer pool stats
+  const string & getName() const { return fileName; }
+  bool isDirect() const { return direct; } // opened with O_DIRECT
 
   bool operator == (const File & other) const
     {
@@ -40,7 +138,7 @@ class File {
   File(const string &fname);                   // initialize
   ~File();                  // deallocate file object
 
-  static const Status create(const string &fileName);
+  static const Status create(const string &fileName, const int pageSize);
   static const Status destroy(const string &fileName);
 
   const Status open();
@@ -50,6 +148,19 @@ class File {
 		 Page* pagePtr) const;        // internal file read
   const Status intwrite(const int pageNo,
 		  const Page* pagePtr);       // internal file write
+  const Status intreadv(const int pageNo, const int count,
+		  Page* const pages[]) const; // internal vectored read
+  const Status intwritev(const int pageNo, const int count,
+		  const Page* const pages[]); // internal vectored write
+  const Status intreadhead(const int pageNo,
+		  Page* pagePtr) const;       // read first PAGESIZE bytes
+  const Status intwritehead(const int pageNo,
+		  const Page* pagePtr);       // write first PAGESIZE bytes
+
+  const Status readHeader();            // cache header and free list
+  const Status writeHeader();           // write them back if changed
+  const Status extendTo(const int upTo); // make room for pages < upTo
+  void setDirect();                     // bypass the kernel page cache
 
 #ifdef DEBUGFREE
   void listFree();                      // list free pages
@@ -58,6 +169,32 @@ class File {
   string fileName;                    // The name of the file
   int openCnt;                        // # times file has been opened
   int unixFile;                       // unix file stream for file
+  bool direct;                        // opened with O_DIRECT
+  int pageSize;                       // bytes per page, from the header
+  mutable std::mutex ioLatch;         // serializes header updates
+                                      // between threads
+
+  // The header page is cached while the file is open and written back
+  // by the final close.  ioLatch guards all of this.
+  int firstPage;                      // page # of first page in file
+  std::atomic<int> numPages;          // total # of pages in file
+  int extentPages;                    // # of pages the file has room for
+  vector<int> freePages;              // free list, head at the back
+  bool headerDirty;                   // cached header differs from disk
+
+  // frames of the buffer pool holding pages of this file, linked
+  // through BufDesc::fileNext/filePrev, and how many of them are dirty
+  mutable std::mutex frameLatch;      // guards the list
+  mutable int residentHead;           // first frame of the list, or -1
+  mutable int residentCount;          // length of the list
+  mutable std::atomic<int> dirtyFrames;
+
+  mutable FileStats stats;            // kept by the buffer manager
+
+  // access pattern as seen by the buffer manager, for read-ahead
+  std::atomic<int> lastRead;          // last page read through the pool
+  std::atomic<int> seqRun;            // sequential reads leading up to it
+  std::atomic<int> readAheadTo;       // pages below this have been prefetched
 };
 
 class BufMgr;
@@ -103,7 +240,8 @@ class DB {
   DB();                                 // initialize open file table
   ~DB();                                // clean up any remaining open files
 
-  const Status createFile(const string & fileName) ;  // create a new file
+  const Status createFile(const string & fileName,
+                          const int pageSize = PAGESIZE); // create a new file
   const Status destroyFile(const string & fileName) ; // destroy a file, 
                                                            // release all space
   const Status openFile(const string & fileName, File* & file);  // open a file
@@ -120,6 +258,7 @@ typedef struct {
   int nextFree;                         // page # of next page on free list
   int firstPage;                        // page # of first page in file
   int numPages;                         // total # of pages in file
+  int pageSize;                         // bytes per page; 0 means PAGESIZE
 } DBPage;
 
 #endif
@@ -28,21 +28,36 @@ const unsigned DPFIXED= sizeof(slot_t)+4*sizeof(short)+2*sizeof(int);
 const unsigned PAGEDATASIZE = PAGESIZE-DPFIXED+sizeof(slot_t);
 // size of the data area of a page
 
+// Page sizes a file may be created with.  PAGESIZE is the default and
+// the smallest; the offsets in a page are shorts, hence the largest.
+const unsigned MAXPAGESIZE = 16384;
+
+inline bool validPageSize(const unsigned size)
+{
+  return size == PAGESIZE || size == 4096 || size == 8192 || size == 16384;
+}
+
 // Class definition for a minirel data page.   
-// The design assumes that records are kept compacted when
-// deletions are performed. Notice, however, that the slot
-// array cannot be compacted.  Notice, this class does not keep
+// Deleting a record leaves a hole in the data area; the holes are
+// squeezed out all at once, when an insert needs the space. Notice,
+// however, that the slot array cannot be compacted, apart from free
+// slots at its end.  Notice, this class does not keep
 // the records align, relying instead on upper levels to take
 // care of non-aligned attributes
+//
+// The page size is a template parameter so that the slotted-page code
+// is compiled for each supported size; page.C instantiates it for all
+// of them.  Page is the default 1 KB page.
 
-class Page {
+template <unsigned SIZE>
+class SlottedPage {
 private:
-    char 	data[PAGESIZE - DPFIXED]; 
+    char 	data[SIZE - DPFIXED]; 
     slot_t 	slot[1]; // first element of slot array - grows backwards!
     short	slotCnt; // number of slots in use;
     short	freePtr; // offset of first free byte in data[]
-    short	freeSpace; // number of bytes free in data[]
-    short	dummy;	// for alignment purposes
+    short	freeSpace; // number of bytes free in data[], holes included
+    short	freeSlot; // 1 + number of the first free slot, 0 if none
     int		nextPage; // forwards pointer
     int		curPage;  // page number of current pointer
 
@@ -70,6 +85,49 @@ public:
 
     // returns reference to record with RID rid
     const Status getRecord(const RID & rid, Record & rec);
+
+    // inserts recs[0..count) in order, as long as they fit; inserted
+    // tells how many did and their RIDs are in rids[].  Returns NOSPACE
+    // if not all of them fit
+    const Status insertRecords(const Record recs[], const int count,
+                               RID rids[], int & inserted);
+
+    // returns the next live records of the page, up to max of them, in
+    // one pass over the slot array.  cursor starts at 0 and is advanced
+    // past the records returned.  Returns ENDOFPAGE when there are none
+    const Status scanRecords(int & cursor, RID rids[], Record recs[],
+                             const int max, int & count);
+
+    // upper bound on the number of records on the page
+    const int getSlotCnt() const { return -slotCnt; }
+
+    // size of the data area of a page
+    static const unsigned DATASIZE = SIZE - DPFIXED + sizeof(slot_t);
+
+private:
+    // The slot array grows backwards from slot[0] into data[], so it is
+    // addressed from the start of the page: the compiler may assume an
+    // index into slot[1] itself is always 0.
+    slot_t* slots() { return (slot_t*)((char*)this + sizeof(data)); }
+    const slot_t* slots() const
+    {
+      return (const slot_t*)((const char*)this + sizeof(data));
+    }
+
+    // bytes between the last record and the slot array
+    int contiguous() const
+    {
+      return SIZE - DPFIXED - freePtr + slotCnt * (int)sizeof(slot_t);
+    }
+
+    void compact();             // squeeze the holes out of data[]
+    const int takeSlot();       // the slot the next record goes in
+    void checkFreeSlot();       // repair freeSlot if it is not to be trusted
 };
 
+typedef SlottedPage<PAGESIZE> Page;
+typedef SlottedPage<4096>     Page4K;
+typedef SlottedPage<8192>     Page8K;
+typedef SlottedPage<16384>    Page16K;
+
 #endif